@@ -73,6 +73,13 @@ void ADS129xADC::pwrUp(const bool& first)
     digitalWriteFast(m_resetPin, HIGH);
     delayMicroseconds(9);
     sendCmd(SDATAC);
+    
+    // Registers are back at their reset values, so the next setup has to write them all
+    memset(m_regs, 0, sizeof(m_regs));
+    m_regsKnown = 0;
+    m_streaming = false;
+    m_singleShot = false;
+    m_shotPeriod = 0;
 }
 
 // Put ADC into standby mode
@@ -136,6 +143,7 @@ void ADS129xADC::chipSelectLow()
 #endif
     digitalWriteFast(m_chipSelectPin, LOW);
     nop;
+    m_busTx++;
 }
 
 // Pull ADC CS pin HIGH
@@ -160,6 +168,11 @@ void ADS129xADC::writeRegister(const uint8_t& reg, const uint8_t& arg)
     SPI.transfer(0x00);         // Number of registers to be read/written minus 1
     SPI.transfer(arg);
     chipSelectHigh();
+    
+    if (reg < NUM_REGS) {
+        m_regs[reg] = arg;
+        m_regsKnown |= (1UL << reg);
+    }
 }
 
 // Read one ADC register
@@ -186,11 +199,15 @@ void ADS129xADC::setRecInfo(const chType chSpec[])
     recSize = (numChCon + m_getGPIO)  * BYTES_P_CH;
 }
 
-// Start ADC conversion and read data continuous mode
+// Start ADC conversion and read data continuous mode, leaves single-shot mode if active
 void ADS129xADC::startStream()
 {
+    if (m_singleShot)
+        stopSingleShot();
+    
     digitalWriteFast(m_startPin, HIGH);
     sendCmd(RDATAC);
+    m_streaming = true;
 }
 
 // Stop ADC conversion and read data continuous mode
@@ -198,75 +215,207 @@ void ADS129xADC::stopStream()
 {
     digitalWriteFast(m_startPin, LOW);
     sendCmd(SDATAC);
+    m_streaming = false;
 }
 
-// Setup signal acquisition
-void ADS129xADC::setAqParams(const uint8_t& res_speed, const bool& intTest, const chType chSpec[], const bool& useGPIO)
+// Stage a register value in a register image
+static inline void stageReg(uint8_t regs[], uint32_t& mask, const uint8_t& reg, const uint8_t& arg)
+{
+    regs[reg] = arg;
+    mask |= (1UL << reg);
+}
+
+// Build register image for the acquisition setup, returns mask of registers set
+uint32_t ADS129xADC::buildRegs(const uint8_t& res_speed, const bool& intTest, const chType chSpec[],
+                               const uint8_t& gain, uint8_t regs[])
 {
     uint8_t RLD_bits2set = 0x00;
-    
-    m_getGPIO = useGPIO;
-    
-    // Setup channel spec
-    setRecInfo(chSpec);
+    uint32_t mask = 0;
     
     // All GPIO set to output (floating CMOS inputs can flicker, creating noise)
-    writeRegister(GPIO, 0x00);
+    stageReg(regs, mask, GPIO, 0x00);
+    
+    // Set ADC resolution and sampling rate
+    stageReg(regs, mask, CONFIG1, res_speed);
     
-    // Set ADC to work at high resolution 1 KS/s sampling rate
-    writeRegister(CONFIG1, res_speed);
+    // Respiration off unless a RES channel below turns it on, keep the conversion mode
+    stageReg(regs, mask, RESP, RESP_const);
+    stageReg(regs, mask, CONFIG4, CONFIG4_const | (m_regs[CONFIG4] & SINGLE_SHOT));
     
     if (intTest) {
         // Generate AC internal test signal at smallest amplitude, but highest freq.
-        writeRegister(CONFIG2, CONFIG2_const | INT_TEST_2HZ);
+        stageReg(regs, mask, CONFIG2, CONFIG2_const | INT_TEST_2HZ);
         
         // Setup all available channel to acquire test signal
         for (int i = 0; i < numChAv; i++)
-            writeRegister(CH1SET + i, CHnSET_const | TEST_SIGNAL | GAIN_X12);
+            stageReg(regs, mask, CH1SET + i, CHnSET_const | TEST_SIGNAL | gain);
     }
     else {
         // Generate DC internal test signal
-        writeRegister(CONFIG2, CONFIG2_const | INT_TEST_DC);
+        stageReg(regs, mask, CONFIG2, CONFIG2_const | INT_TEST_DC);
         
         // Setup all available channel to acquire test signal
         for (int i = 0; i < numChAv; i++) {
-            switch (m_chSpec[i]) {
+            switch (chSpec[i]) {
                 case RES:
-                    writeRegister(RESP, RESP_DEMOD_EN1 | RESP_MOD_EN1 | RESP_PH_135 | RESP_const | RESP_INT_SIG_INT);
-                    writeRegister(CONFIG4, CONFIG4_const | RESP_FREQ_32k_Hz);
-                    writeRegister(CH1SET, CHnSET_const | ELECTRODE_INPUT | GAIN_X4);
+                    stageReg(regs, mask, RESP, RESP_DEMOD_EN1 | RESP_MOD_EN1 | RESP_PH_135 | RESP_const | RESP_INT_SIG_INT);
+                    stageReg(regs, mask, CONFIG4, CONFIG4_const | RESP_FREQ_32k_Hz | (m_regs[CONFIG4] & SINGLE_SHOT));
+                    stageReg(regs, mask, CH1SET, CHnSET_const | ELECTRODE_INPUT | GAIN_X4);
                     break;
                 case SEN:
-                    writeRegister(CH1SET + i, CHnSET_const | ELECTRODE_INPUT | GAIN_X12);
+                    stageReg(regs, mask, CH1SET + i, CHnSET_const | ELECTRODE_INPUT | gain);
                     break;
                 case PHY:
-                    writeRegister(CH1SET + i, CHnSET_const | ELECTRODE_INPUT | GAIN_X12);
+                    stageReg(regs, mask, CH1SET + i, CHnSET_const | ELECTRODE_INPUT | gain);
                     RLD_bits2set |= (1<<i);
                     break;
                 default:
-                    writeRegister(CH1SET + i, PD_CH | SHORTED);
+                    stageReg(regs, mask, CH1SET + i, PD_CH | SHORTED);
                     break;
             }
         }
     }
     
-    if (RLD_bits2set) {
-        writeRegister(CONFIG3, RLDREF_INT | PD_RLD | PD_REFBUF | CONFIG3_const);
-        writeRegister(RLD_SENSP, RLD_bits2set);
-        writeRegister(RLD_SENSN, RLD_bits2set);
-    }
-    else {
-        writeRegister(CONFIG3, PD_REFBUF | CONFIG3_const);
+    if (RLD_bits2set)
+        stageReg(regs, mask, CONFIG3, RLDREF_INT | PD_RLD | PD_REFBUF | CONFIG3_const);
+    else
+        stageReg(regs, mask, CONFIG3, PD_REFBUF | CONFIG3_const);
+    
+    // Always staged so a diff against the previous setup also clears stale RLD sense bits
+    stageReg(regs, mask, RLD_SENSP, RLD_bits2set);
+    stageReg(regs, mask, RLD_SENSN, RLD_bits2set);
+    
+    return mask;
+}
+
+// Setup signal acquisition
+void ADS129xADC::setAqParams(const uint8_t& res_speed, const bool& intTest, const chType chSpec[],
+                             const bool& useGPIO, const uint8_t& gain)
+{
+    uint8_t regs[NUM_REGS];
+    uint32_t mask = buildRegs(res_speed, intTest, chSpec, gain, regs);
+    
+    m_getGPIO = useGPIO;
+    
+    // Setup channel spec
+    setRecInfo(chSpec);
+    
+    for (int reg = 0; reg < NUM_REGS; reg++) {
+        if (mask & (1UL << reg)) {
+            // Offsets measured at another gain or input no longer apply
+            if (reg >= CH1SET && reg < CH1SET + MAX_CH_NUM && regs[reg] != m_regs[reg]) {
+                calInfo.offset[reg - CH1SET] = 0;
+                calInfo.valid = false;
+            }
+            writeRegister(reg, regs[reg]);
+        }
     }
 }
 
+// Current data rate (SPS)
+uint32_t ADS129xADC::sampleRate()
+{
+    uint32_t fMod = (m_regs[CONFIG1] & HR)? 32000 : 16000;
+    return fMod >> (m_regs[CONFIG1] & DR_MASK);
+}
 
-// Fetch samples writing data to the buffer supplied
-void ADS129xADC::fetchData(uint8_t* chData)
+// Sample period at the current data rate (us)
+uint32_t ADS129xADC::samplePeriodUs()
 {
-    int dataIdx = 0;
+    return 1000000UL / sampleRate();
+}
+
+// Record a gap in the stream to be reported by the next fetch
+void ADS129xADC::markGap(const uint32_t& lengthUs, const uint32_t& periodUs, const int& regWrites)
+{
+    uint32_t periods = (lengthUs + periodUs / 2) / periodUs;
+    
+    lastGap.lengthUs = lengthUs;
+    lastGap.lostSamples = (periods > 0)? periods - 1 : 0;
+    lastGap.regWrites = regWrites;
+    m_gapPending = lastGap.lostSamples;
+}
+
+// Apply a new acquisition setup writing only changed registers, returns number of register writes.
+// Call right after fetchData so the writes start at the beginning of a sample period.
+// Lost samples are counted in sample periods of the new data rate.
+int ADS129xADC::reconfigure(const uint8_t& res_speed, const bool& intTest, const chType chSpec[],
+                            const bool& useGPIO, const uint8_t& gain)
+{
+    bool wasSingleShot = suspendSingleShot();   // Before building, so CONFIG4 is staged without SINGLE_SHOT
+    uint8_t regs[NUM_REGS];
+    uint32_t mask = buildRegs(res_speed, intTest, chSpec, gain, regs);
+    bool restart = false;
+    bool wasStreaming = m_streaming;
+    int writes = 0;
+    uint32_t start = micros();
+    
+    // Drop registers known to already hold the requested value
+    for (int reg = 0; reg < NUM_REGS; reg++) {
+        if ((mask & m_regsKnown & (1UL << reg)) && regs[reg] == m_regs[reg])
+            mask &= ~(1UL << reg);
+    }
+    
+    if (wasStreaming)
+        sendCmd(SDATAC);        // Conversions keep running, only register access is unlocked
+    
+    for (int reg = 0; reg < NUM_REGS; reg++) {
+        if (mask & (1UL << reg)) {
+            writeRegister(reg, regs[reg]);
+            writes++;
+            // Rate, reference, channel and respiration changes need the digital filter restarted
+            if (reg == CONFIG1 || reg == CONFIG3 || reg == RESP || reg == CONFIG4 ||
+                (reg >= CH1SET && reg < CH1SET + MAX_CH_NUM))
+                restart = true;
+            // Offsets measured at the old gain or input no longer apply
+            if (reg >= CH1SET && reg < CH1SET + MAX_CH_NUM) {
+                calInfo.offset[reg - CH1SET] = 0;
+                calInfo.valid = false;
+            }
+        }
+    }
+    
+    m_getGPIO = useGPIO;
+    setRecInfo(chSpec);
+    
+    if (!wasStreaming) {
+        if (wasSingleShot)
+            resumeSingleShot();
+        return writes;
+    }
+    
+    if (restart) {
+        digitalWriteFast(m_startPin, LOW);
+        delayMicroseconds(1);
+        digitalWriteFast(m_startPin, HIGH);
+    }
+    sendCmd(RDATAC);
+    
+    // Gap ends at the first DRDY edge after resuming
+    waitNewDRDY();
+    markGap(micros() - start, samplePeriodUs(), writes);
+    
+    return writes;
+}
+
+// Fetch samples writing data to the buffer supplied, returns samples lost before this frame
+int ADS129xADC::fetchData(uint8_t* chData)
+{
+    int lost = m_gapPending;
+    
+    m_gapPending = 0;
     
     chipSelectLow();
+    readRec(chData);
+    chipSelectHigh();
+    
+    return lost;
+}
+
+// Clock out one frame keeping the status word if GPIO data is required and connected channels only
+void ADS129xADC::readRec(uint8_t* chData)
+{
+    int dataIdx = 0;
     
     if (m_getGPIO) {
         chData[dataIdx++] = SPI.transfer(0);
@@ -295,6 +444,293 @@ void ADS129xADC::fetchData(uint8_t* chData)
                 break;
         }
     }
+}
+
+// Wait for DRDY to go low
+void ADS129xADC::waitDRDY()
+{
+    while (digitalReadFast(m_dRdyPin) == HIGH);
+}
+
+// Wait for the next DRDY falling edge, skipping a frame left unread from before
+void ADS129xADC::waitNewDRDY()
+{
+    while (digitalReadFast(m_dRdyPin) == LOW);
+    waitDRDY();
+}
+
+// Read one 24-bit word from the bus, MSB first
+uint32_t ADS129xADC::readWord()
+{
+    uint32_t word = (uint32_t)SPI.transfer(0) << 16;
+    word |= (uint32_t)SPI.transfer(0) << 8;
+    word |= SPI.transfer(0);
+    return word;
+}
+
+// Read status word and all available channels, sign extended
+uint32_t ADS129xADC::readFrame(int32_t* raw)
+{
+    uint32_t status;
+    
+    chipSelectLow();
+    status = readWord();
+    for (int i = 0; i < numChAv; i++)
+        raw[i] = (int32_t)(readWord() << 8) >> 8;
     chipSelectHigh();
+    
+    return status;
 }
 
+// Fetch sign extended samples with calibrated offsets removed, returns samples lost before this frame
+int ADS129xADC::fetchData(int32_t* chData)
+{
+    int dataIdx = 0;
+    int lost = m_gapPending;
+    
+    m_gapPending = 0;
+    
+    chipSelectLow();
+    
+    if (m_getGPIO)
+        chData[dataIdx++] = readWord();
+    else
+        readWord();
+    
+    for (int i = 0; i < numChAv; i++) {
+        switch (m_chSpec[i]) {
+            case RES:
+            case SEN:
+            case PHY:
+                chData[dataIdx++] = ((int32_t)(readWord() << 8) >> 8) - calInfo.offset[i];
+                break;
+            default:
+                readWord();
+                break;
+        }
+    }
+    chipSelectHigh();
+    
+    return lost;
+}
+
+// Stream nSamples frames accumulating mean and RMS deviation per channel
+void ADS129xADC::acquireStats(const int& nSamples, int32_t mean[], float rms[])
+{
+    int32_t raw[MAX_CH_NUM];
+    int32_t first[MAX_CH_NUM];
+    int64_t sum[MAX_CH_NUM] = {};
+    int64_t sumSq[MAX_CH_NUM] = {};
+    int n = (nSamples > 0)? nSamples : 1;
+    
+    // A conversion finished after the last stopStream() can leave DRDY low with data from
+    // the previous input selection, so only take frames behind a fresh DRDY edge
+    startStream();
+    for (int s = 0; s < n; s++) {
+        waitNewDRDY();
+        readFrame(raw);
+        for (int i = 0; i < numChAv; i++) {
+            if (s == 0)
+                first[i] = raw[i];
+            // Accumulate relative to the first sample to keep the sums small
+            int32_t dev = raw[i] - first[i];
+            sum[i] += dev;
+            sumSq[i] += (int64_t)dev * dev;
+        }
+    }
+    stopStream();
+    
+    for (int i = 0; i < numChAv; i++) {
+        double avg = (double)sum[i] / n;
+        double var = (double)sumSq[i] / n - avg * avg;
+        mean[i] = first[i] + (int32_t)lround(avg);
+        rms[i] = (var > 0)? sqrt(var) : 0;
+    }
+}
+
+// Convert code to volts with the given PGA gain
+float ADS129xADC::codeToVolts(const int32_t& code, const int& gain)
+{
+    float vRef = (m_regs[CONFIG3] & VREF_4V)? 4.0f : 2.4f;
+    return code * vRef / (gain * 8388607.0f);
+}
+
+// Measure per channel offset and noise with inputs shorted, then temperature and supplies
+void ADS129xADC::calibrate(const int& nSamples)
+{
+    uint8_t chSet[MAX_CH_NUM];
+    int32_t mean[MAX_CH_NUM];
+    float rms[MAX_CH_NUM];
+    bool wasStreaming = m_streaming;
+    bool wasSingleShot = suspendSingleShot();
+    uint8_t resp;
+    int writes = 3 + numChAv;
+    uint32_t start = micros();
+    
+    if (wasStreaming)
+        stopStream();
+    
+    // Short the inputs of connected channels keeping their gain
+    for (int i = 0; i < numChAv; i++) {
+        chSet[i] = m_regs[CH1SET + i];
+        if (m_chSpec[i] != NC) {
+            writeRegister(CH1SET + i, (chSet[i] & ~MUX_MASK) | SHORTED);
+            writes++;
+        }
+    }
+    acquireStats(nSamples, mean, rms);
+    for (int i = 0; i < numChAv; i++) {
+        calInfo.offset[i] = (m_chSpec[i] != NC)? mean[i] : 0;
+        calInfo.noise[i] = (m_chSpec[i] != NC)? rms[i] : 0;
+    }
+    
+    // Respiration demodulation on channel 1 would distort the temperature reading
+    resp = m_regs[RESP];
+    if (resp & (RESP_DEMOD_EN1 | RESP_MOD_EN1)) {
+        writeRegister(RESP, RESP_const);
+        writes += 2;
+    }
+    
+    // Temperature on channel 1, (AVDD + AVSS)/2 on channel 2 and DVDD/4 on channel 3, all at gain 1
+    writeRegister(CH1SET, CHnSET_const | GAIN_X1 | TEMP);
+    writeRegister(CH2SET, CHnSET_const | GAIN_X1 | MVDD);
+    writeRegister(CH3SET, CHnSET_const | GAIN_X1 | MVDD);
+    acquireStats(CAL_HEALTH_SMPL, mean, rms);
+    calInfo.tempC = (codeToVolts(mean[0], 1) * 1e6f - 145300.0f) / 490.0f + 25.0f;    // 145.3 mV at 25 C, 490 uV/C
+    calInfo.avddV = 2.0f * codeToVolts(mean[1], 1);
+    calInfo.dvddV = 4.0f * codeToVolts(mean[2], 1);
+    
+    // Restore channel and respiration settings
+    for (int i = 0; i < numChAv; i++)
+        writeRegister(CH1SET + i, chSet[i]);
+    if (resp & (RESP_DEMOD_EN1 | RESP_MOD_EN1))
+        writeRegister(RESP, resp);
+    
+    if (wasStreaming) {
+        startStream();
+        waitNewDRDY();
+    }
+    if (wasSingleShot)
+        resumeSingleShot();
+    
+    calInfo.downtimeUs = micros() - start;
+    calInfo.valid = true;
+    if (wasStreaming)
+        markGap(calInfo.downtimeUs, samplePeriodUs(), writes);
+}
+
+// Schedule background calibration every periodMs (0 disables)
+void ADS129xADC::setCalSchedule(const uint32_t& periodMs, const int& nSamples)
+{
+    m_calPeriod = periodMs;
+    m_calSamples = nSamples;
+    m_calLast = millis();
+}
+
+// Run scheduled calibration if due, returns true if a cycle was run
+bool ADS129xADC::serviceCal()
+{
+    if (!m_calPeriod || (millis() - m_calLast) < m_calPeriod)
+        return false;
+    
+    calibrate(m_calSamples);
+    m_calLast = millis();
+    return true;
+}
+
+// Wake ADC and leave single-shot conversion mode for a driver operation, returns true if it was active
+bool ADS129xADC::suspendSingleShot()
+{
+    if (!m_singleShot)
+        return false;
+    
+    wakeup();
+    writeRegister(CONFIG4, m_regs[CONFIG4] & ~SINGLE_SHOT);
+    m_singleShot = false;
+    return true;
+}
+
+// Return to single-shot conversion mode in standby
+void ADS129xADC::resumeSingleShot()
+{
+    writeRegister(CONFIG4, m_regs[CONFIG4] | SINGLE_SHOT);
+    standby();
+    m_singleShot = true;
+}
+
+// Enter single-shot mode converting every periodMs into batch, which holds batchLen records of recSize bytes,
+// returns false and leaves the ADC untouched if an argument is invalid or setAqParams() was not called
+bool ADS129xADC::startSingleShot(const uint32_t& periodMs, uint8_t* batch, const int& batchLen)
+{
+    if (periodMs == 0 || !batch || batchLen <= 0 || recSize <= 0)
+        return false;
+    
+    if (m_streaming)
+        stopStream();
+    
+    resumeSingleShot();
+    
+    m_shotPeriod = periodMs;
+    m_shotBatch = batch;
+    m_shotLen = batchLen;
+    m_shotIdx = 0;
+    m_shotLast = millis() - periodMs;   // First conversion is due straight away
+    m_shotStart = micros();
+    m_shotTx = m_busTx;
+    shotStats = ADS129xShotStats();
+    return true;
+}
+
+// Leave single-shot mode with the ADC awake and in continuous conversion mode
+void ADS129xADC::stopSingleShot()
+{
+    m_shotPeriod = 0;
+    suspendSingleShot();
+}
+
+// Run a wake, convert, read, sleep cycle if due, returns batch length when the batch is full, 0 otherwise
+int ADS129xADC::serviceSingleShot()
+{
+    uint32_t wake;
+    
+    if (!m_shotPeriod || (millis() - m_shotLast) < m_shotPeriod)
+        return 0;
+    m_shotLast += m_shotPeriod;
+    if ((millis() - m_shotLast) >= m_shotPeriod)
+        m_shotLast = millis();          // More than a period late, skip the missed slots instead of bursting
+    
+    wake = micros();
+    wakeup();
+    
+    // START pulse converts once without a bus transaction. DRDY may still be low from an
+    // unread earlier conversion, so wait for it to go high before waiting for the new data
+    digitalWriteFast(m_startPin, HIGH);
+    waitNewDRDY();
+    shotStats.latencyUs = micros() - wake;
+    digitalWriteFast(m_startPin, LOW);
+    
+    // Read the conversion in the same transaction as the RDATA opcode
+    chipSelectLow();
+    SPI.transfer(RDATA);
+    readRec(m_shotBatch + m_shotIdx * recSize);
+    chipSelectHigh();
+    
+    standby();
+    
+    shotStats.samples++;
+    shotStats.awakeUs += micros() - wake;
+    shotStats.elapsedUs = micros() - m_shotStart;
+    shotStats.busTx = m_busTx - m_shotTx;
+    
+    if (++m_shotIdx < m_shotLen)
+        return 0;
+    
+    m_shotIdx = 0;
+    return m_shotLen;
+}
+
+// Bus transactions (chip select cycles) since construction
+uint32_t ADS129xADC::busTransactions()
+{
+    return m_busTx;
+}
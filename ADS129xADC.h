@@ -30,6 +30,9 @@
 #define USE_SOFT_SPI    1
 #define MAX_CH_NUM      8
 #define BYTES_P_CH      3
+#define NUM_REGS        26      // Number of ADC registers (ID to WCT2)
+#define CAL_HEALTH_SMPL 8       // Samples averaged for temperature and supply readings
+#define ADS_DEFAULT_GAIN 0x60   // PGA gain 12 (GAIN_X12)
 
 // Select bit-bang (Soft) SPI
 #if USE_SOFT_SPI
@@ -60,6 +63,36 @@ enum chType
     RES         // Use impedance pneumography with R series device (valid type for channel 1 only!) not used for RLD
 };
 
+// Offset calibration and health check results
+struct ADS129xCalInfo
+{
+    bool valid;                     // At least one calibration cycle has completed
+    int32_t offset[MAX_CH_NUM];     // Mean input shorted reading per channel (codes)
+    float noise[MAX_CH_NUM];        // RMS input shorted noise per channel (codes)
+    float tempC;                    // Die temperature (deg C)
+    float avddV;                    // Analog supply AVDD - AVSS, unipolar supply assumed (V)
+    float dvddV;                    // Digital supply DVDD (V)
+    uint32_t downtimeUs;            // Streaming downtime of the last calibration cycle (us)
+};
+
+// Gap left in the stream by a reconfiguration or calibration cycle
+struct ADS129xGap
+{
+    uint32_t lengthUs;              // Time from resuming access to the first frame after the gap (us)
+    uint32_t lostSamples;           // Sample periods without data, at the data rate after the gap
+    int regWrites;                  // Registers written during the gap
+};
+
+// Single-shot duty cycling statistics, continuous mode uses one bus transaction per sample
+struct ADS129xShotStats
+{
+    uint32_t samples;               // Conversions read
+    uint32_t latencyUs;             // Wake to data ready latency of the last conversion (us)
+    uint32_t awakeUs;               // Time spent awake, awakeUs/elapsedUs is the duty cycle (us)
+    uint32_t elapsedUs;             // Time from entering single-shot mode to the last conversion (us)
+    uint32_t busTx;                 // Bus transactions (chip select cycles), busTx/samples per sample
+};
+
 class ADS129xADC
 {
 private:
@@ -78,13 +111,59 @@ private:
     bool m_getGPIO  = false;
     bool m_respEN   = false;
     chType m_chSpec[MAX_CH_NUM];
+    uint8_t m_regs[NUM_REGS] = {};  // Last value written to each register
+    uint32_t m_regsKnown  = 0;      // Registers written since the last reset
+    bool m_streaming = false;
+    // Background calibration schedule
+    uint32_t m_calPeriod  = 0;
+    uint32_t m_calLast    = 0;
+    int m_calSamples      = 0;
+    int m_gapPending      = 0;  // Lost samples to report with the next fetched frame
+    uint32_t m_busTx      = 0;  // Chip select cycles since construction
+    // Single-shot schedule and batch
+    uint32_t m_shotPeriod = 0;
+    uint32_t m_shotLast   = 0;
+    uint32_t m_shotStart  = 0;
+    uint32_t m_shotTx     = 0;
+    uint8_t* m_shotBatch  = 0;
+    int m_shotLen         = 0;
+    int m_shotIdx         = 0;
+    bool m_singleShot     = false;  // SINGLE_SHOT set and ADC in standby between conversions
     // Initialise ADC interface pins
     void initPins();
     void setRecInfo(const chType chSpec[]);
+    // Wait for DRDY to go low
+    void waitDRDY();
+    // Wait for the next DRDY falling edge, skipping a frame left unread from before
+    void waitNewDRDY();
+    // Wake ADC and leave single-shot conversion mode for a driver operation, returns true if it was active
+    bool suspendSingleShot();
+    // Return to single-shot conversion mode in standby
+    void resumeSingleShot();
+    // Clock out one record of recSize bytes
+    void readRec(uint8_t* chData);
+    // Read one 24-bit word from the bus
+    uint32_t readWord();
+    // Read status word and all available channels, sign extended
+    uint32_t readFrame(int32_t* raw);
+    // Stream nSamples frames accumulating mean and RMS deviation per channel
+    void acquireStats(const int& nSamples, int32_t mean[], float rms[]);
+    // Convert code to volts with the given PGA gain
+    float codeToVolts(const int32_t& code, const int& gain);
+    // Build register image for the acquisition setup, returns mask of registers set
+    uint32_t buildRegs(const uint8_t& res_speed, const bool& intTest, const chType chSpec[],
+                       const uint8_t& gain, uint8_t regs[]);
+    // Sample period at the current data rate (us)
+    uint32_t samplePeriodUs();
+    // Record a gap in the stream to be reported by the next fetch
+    void markGap(const uint32_t& lengthUs, const uint32_t& periodUs, const int& regWrites);
 public:
     int numChAv     = 0;
     int numChCon    = 0;
     int recSize     = 0;
+    ADS129xCalInfo calInfo = {};
+    ADS129xGap lastGap = {};
+    ADS129xShotStats shotStats = {};
     // Bring interface pin numbers into private vars at construction
     ADS129xADC(const int& pwdnPin = ADS_PWDN_PIN, \
                const int& resetPin = ADS_RESET_PIN, \
@@ -102,13 +181,20 @@ public:
     void wakeup();
     // Get ADC ID
     void getID();
-    // Start ADC conversion and read data continuous mode
+    // Current data rate (SPS)
+    uint32_t sampleRate();
+    // Start ADC conversion and read data continuous mode, leaves single-shot mode if active
     void startStream(void);
     // Stop ADC conversion and read data continuous mode
     void stopStream(void);
     // Setup signal acquisition
     void setAqParams(const uint8_t& res_speed, const bool& intTest,
-                     const chType chSpec[], const bool& useGPIO = false);
+                     const chType chSpec[], const bool& useGPIO = false,
+                     const uint8_t& gain = ADS_DEFAULT_GAIN);
+    // Change acquisition setup while streaming, writing only the registers that differ
+    int reconfigure(const uint8_t& res_speed, const bool& intTest,
+                    const chType chSpec[], const bool& useGPIO = false,
+                    const uint8_t& gain = ADS_DEFAULT_GAIN);
     // Initialize ADC pins, power it up and test comms by fetching and saving ID
     void startUp();
     // Start continuous data stream
@@ -117,7 +203,23 @@ public:
     void writeRegister(const uint8_t& reg, const uint8_t& arg);
     // Read single ADC register
     uint8_t readRegister(const uint8_t& reg);
-    // Fetch data from ADC, specify number of channels to fetch and if GPIO data is required
-    void fetchData(uint8_t* chData);
+    // Fetch data from ADC, returns number of samples lost to a gap before this frame
+    int fetchData(uint8_t* chData);
+    // Fetch sign extended samples with calibrated offsets removed
+    int fetchData(int32_t* chData);
+    // Measure per channel offset and noise with inputs shorted, then temperature and supplies
+    void calibrate(const int& nSamples);
+    // Schedule background calibration every periodMs (0 disables)
+    void setCalSchedule(const uint32_t& periodMs, const int& nSamples);
+    // Run scheduled calibration if due, returns true if a cycle was run
+    bool serviceCal();
+    // Enter single-shot mode converting every periodMs into batch of batchLen records, false if arguments are invalid
+    bool startSingleShot(const uint32_t& periodMs, uint8_t* batch, const int& batchLen);
+    // Leave single-shot mode with the ADC awake
+    void stopSingleShot();
+    // Run a wake, convert, read, sleep cycle if due, returns batch length when the batch is full
+    int serviceSingleShot();
+    // Bus transactions (chip select cycles) since construction
+    uint32_t busTransactions();
 };
 #endif /* ADS129xADC_h */
@@ -62,6 +62,8 @@ uint8_t const CONFIG1           = 0x01;
 uint8_t const CONFIG1_const     = 0x00; // Bits[4:3] must always bet set to 0, always use this const when configuring!
 uint8_t const DAISY_EN          = 0x40; // Multiple readback mode
 uint8_t const CLK_EN            = 0x20; // Internal oscillator signal is connected to the CLK pin
+uint8_t const HR                = 0x80; // High-resolution mode
+uint8_t const DR_MASK           = 0x07; // Output data rate field DR[2:0]
 /** For High-Resolution mode: fMOD = fCLK/4 */
 uint8_t const HIGH_RES_32k_SPS  = 0x80; // Data rate is fMOD/16
 uint8_t const HIGH_RES_16k_SPS  = 0x81; // Data rate is fMOD/32
@@ -140,6 +142,8 @@ uint8_t const CHnSET_const      = 0x00; // Bit[3] must always bet set to 1, alwa
 
 uint8_t const PD_CH             = 0x80; // Channel power-down. Recommended that the channel be set to input short MUXn[2:0] = 001.
 
+uint8_t const MUX_MASK          = 0x07; // Input selection field MUXn[2:0]
+
 uint8_t const GAIN_X6           = 0x00; // PGA gain is 6 (default)
 uint8_t const GAIN_X1           = 0x10; // PGA gain is 1
 uint8_t const GAIN_X2           = 0x20; // PGA gain is 2
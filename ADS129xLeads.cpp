@@ -0,0 +1,149 @@
+/* Teensy ADS129xADC library
+ * Copyright (C) 2014 by Valentin Goverdovsky
+ *
+ * This file is part of the Teensy ADS129xADC Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Teensy ADS129xADC Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "ADS129xLeads.h"
+
+// Remove all terms and set the number of samples per input frame, returns false if out of range
+bool ADS129xLeads::clear(const int& numIn)
+{
+    m_numOut = 0;
+    m_numTerms = 0;
+    
+    if (numIn <= 0 || numIn > LEADS_MAX_IN) {
+        m_numIn = 0;
+        return false;
+    }
+    
+    m_numIn = numIn;
+    return true;
+}
+
+// Add weight x input to output, returns false if out of range or full
+bool ADS129xLeads::addTerm(const int& out, const int& in, const float& weight)
+{
+    int pos = m_numTerms;
+    
+    if (out < 0 || out >= LEADS_MAX_OUT || in < 0 || in >= m_numIn || m_numTerms >= LEADS_MAX_TERMS)
+        return false;
+    
+    // Insert keeping terms grouped by output
+    while (pos > 0 && m_termOut[pos - 1] > out) {
+        m_termOut[pos] = m_termOut[pos - 1];
+        m_termIn[pos] = m_termIn[pos - 1];
+        m_termW[pos] = m_termW[pos - 1];
+        pos--;
+    }
+    m_termOut[pos] = out;
+    m_termIn[pos] = in;
+    m_termW[pos] = (int32_t)lroundf(weight * (1L << LEADS_Q));
+    m_numTerms++;
+    
+    if (out >= m_numOut)
+        m_numOut = out + 1;
+    
+    return true;
+}
+
+// 12-lead ECG from 8 inputs in ADS1298 ECG order (V6, I, II, V2, V3, V4, V5, V1) starting at first
+bool ADS129xLeads::setEinthoven12(const int& numIn, const int& first)
+{
+    const int I = first + 1, II = first + 2;
+    bool ok = clear(numIn);
+    
+    // Einthoven limb leads
+    ok &= addTerm(0, I, 1.0f);
+    ok &= addTerm(1, II, 1.0f);
+    ok &= addTerm(2, II, 1.0f);         // III = II - I
+    ok &= addTerm(2, I, -1.0f);
+    // Goldberger augmented leads
+    ok &= addTerm(3, I, -0.5f);         // aVR = -(I + II)/2
+    ok &= addTerm(3, II, -0.5f);
+    ok &= addTerm(4, I, 1.0f);          // aVL = I - II/2
+    ok &= addTerm(4, II, -0.5f);
+    ok &= addTerm(5, II, 1.0f);         // aVF = II - I/2
+    ok &= addTerm(5, I, -0.5f);
+    // Precordial leads V1 to V6, measured against WCT
+    ok &= addTerm(6, first + 7, 1.0f);
+    ok &= addTerm(7, first + 3, 1.0f);
+    ok &= addTerm(8, first + 4, 1.0f);
+    ok &= addTerm(9, first + 5, 1.0f);
+    ok &= addTerm(10, first + 6, 1.0f);
+    ok &= addTerm(11, first, 1.0f);
+    
+    return ok;
+}
+
+// Each of numCh inputs starting at first referenced to their common average
+bool ADS129xLeads::setCommonAverage(const int& numIn, const int& first, const int& numCh)
+{
+    bool ok = clear(numIn) && (numCh > 0);
+    
+    for (int o = 0; o < numCh && ok; o++) {
+        for (int i = 0; i < numCh; i++)
+            ok &= addTerm(o, first + i, ((o == i)? 1.0f : 0.0f) - 1.0f / numCh);
+    }
+    
+    return ok;
+}
+
+// Bipolar chain of numCh inputs starting at first, output i = input i - input i+1
+bool ADS129xLeads::setBipolar(const int& numIn, const int& first, const int& numCh)
+{
+    bool ok = clear(numIn) && (numCh > 1);
+    
+    for (int o = 0; o < numCh - 1 && ok; o++) {
+        ok &= addTerm(o, first + o, 1.0f);
+        ok &= addTerm(o, first + o + 1, -1.0f);
+    }
+    
+    return ok;
+}
+
+// Derive nFrames output frames from nFrames input frames
+void ADS129xLeads::apply(const int32_t* in, int32_t* out, const int& nFrames)
+{
+    for (int f0 = 0; f0 < nFrames; f0 += LEADS_BLOCK) {
+        int n = (nFrames - f0 < LEADS_BLOCK)? nFrames - f0 : LEADS_BLOCK;
+        int t = 0;
+        
+        // Transpose so every term below walks contiguous memory
+        for (int f = 0; f < n; f++) {
+            for (int i = 0; i < m_numIn; i++)
+                m_blk[i][f] = in[i];
+            in += m_numIn;
+        }
+        
+        for (int o = 0; o < m_numOut; o++) {
+            for (int f = 0; f < n; f++)
+                m_acc[f] = 0;
+            
+            // Multiply-accumulate over the block, maps onto SMLAL on Cortex-M4 and vectorises on hosts
+            for (; t < m_numTerms && m_termOut[t] == o; t++) {
+                const int32_t* x = m_blk[m_termIn[t]];
+                const int64_t w = m_termW[t];
+                for (int f = 0; f < n; f++)
+                    m_acc[f] += w * x[f];
+            }
+            
+            for (int f = 0; f < n; f++)
+                out[f * m_numOut + o] = (int32_t)((m_acc[f] + (1L << (LEADS_Q - 1))) >> LEADS_Q);
+        }
+        out += n * m_numOut;
+    }
+}
@@ -0,0 +1,61 @@
+/* Teensy ADS129xADC library
+ * Copyright (C) 2014 by Valentin Goverdovsky
+ *
+ * This file is part of the Teensy ADS129xADC Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Teensy ADS129xADC Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef ADS129xLeads_h
+#define ADS129xLeads_h
+
+#include "Arduino.h"
+
+#define LEADS_MAX_IN    16      // Max samples per input frame
+#define LEADS_MAX_OUT   16      // Max derived channels per output frame
+#define LEADS_MAX_TERMS (LEADS_MAX_IN * LEADS_MAX_IN)  // Max non-zero matrix entries, enough for a dense common average
+#define LEADS_BLOCK     16      // Frames processed per kernel pass
+#define LEADS_Q         16      // Fractional bits of the fixed point term weights
+
+// Linear re-referencing of sample frames through a sparse input to output matrix
+class ADS129xLeads
+{
+private:
+    int m_numIn     = 0;
+    int m_numOut    = 0;
+    int m_numTerms  = 0;
+    // Non-zero entries kept sorted by output channel
+    uint8_t m_termOut[LEADS_MAX_TERMS];
+    uint8_t m_termIn[LEADS_MAX_TERMS];
+    int32_t m_termW[LEADS_MAX_TERMS];
+    // Block of input frames transposed to channel major order
+    int32_t m_blk[LEADS_MAX_IN][LEADS_BLOCK];
+    int64_t m_acc[LEADS_BLOCK];
+public:
+    // Remove all terms and set the number of samples per input frame, returns false if out of range
+    bool clear(const int& numIn);
+    // Add weight x input to output, returns false if out of range or full
+    bool addTerm(const int& out, const int& in, const float& weight);
+    // 12-lead ECG from 8 inputs in ADS1298 ECG order (V6, I, II, V2, V3, V4, V5, V1) starting at first
+    bool setEinthoven12(const int& numIn, const int& first = 0);
+    // Each of numCh inputs starting at first referenced to their common average
+    bool setCommonAverage(const int& numIn, const int& first, const int& numCh);
+    // Bipolar chain of numCh inputs starting at first, output i = input i - input i+1
+    bool setBipolar(const int& numIn, const int& first, const int& numCh);
+    // Number of samples per output frame
+    int numOut() const { return m_numOut; }
+    // Derive nFrames output frames from nFrames input frames
+    void apply(const int32_t* in, int32_t* out, const int& nFrames);
+};
+#endif /* ADS129xLeads_h */
@@ -0,0 +1,276 @@
+/* Teensy ADS129xADC library
+ * Copyright (C) 2014 by Valentin Goverdovsky
+ *
+ * This file is part of the Teensy ADS129xADC Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Teensy ADS129xADC Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "ADS129xSpectrum.h"
+
+// Decimate sps to at most SPEC_MAX_FFT, size FFT to about 1 s of data, update every updateMs, channels start at frame[first], clears bands
+bool ADS129xSpectrum::begin(const uint32_t& sps, const int& numCh, const uint32_t& updateMs, const int& first)
+{
+    float winPow = 0;
+    
+    if (sps == 0 || numCh <= 0 || numCh > MAX_CH_NUM || first < 0 || first > 1)
+        return false;
+    
+    // Block averaging before decimation keeps bins near 1 Hz at high data rates, its sinc
+    // response has nulls at multiples of the decimated rate where aliases would fold in
+    m_decim = (sps + SPEC_MAX_FFT - 1) / SPEC_MAX_FFT;
+    m_fs = (float)sps / m_decim;
+    m_numCh = numCh;
+    m_first = first;
+    m_nfft = SPEC_MIN_FFT;
+    while (m_nfft < SPEC_MAX_FFT && m_nfft < m_fs)
+        m_nfft <<= 1;
+    
+    m_hop = (int)(m_fs * updateMs / 1000);
+    if (m_hop < 1)
+        m_hop = 1;
+    if (m_hop > m_nfft)
+        m_hop = m_nfft;
+    
+    // Hann window and twiddles exp(-2 pi i k / N)
+    for (int n = 0; n < m_nfft; n++) {
+        m_win[n] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * n / m_nfft);
+        winPow += m_win[n] * m_win[n];
+    }
+    for (int k = 0; k < m_nfft / 2; k++) {
+        m_cos[k] = cosf(2.0f * (float)M_PI * k / m_nfft);
+        m_sin[k] = sinf(2.0f * (float)M_PI * k / m_nfft);
+    }
+    m_scale = 1.0f / (m_fs * winPow);
+    
+    m_pos = 0;
+    m_filled = 0;
+    m_sinceUpd = 0;
+    m_decCount = 0;
+    memset(m_decSum, 0, sizeof(m_decSum));
+    m_numBands = 0;
+    m_segments = 0;
+    m_updCh = -1;
+    updateUs = 0;
+    pushMaxUs = 0;
+    memset(m_psd, 0, sizeof(m_psd));
+    memset(m_bandPow, 0, sizeof(m_bandPow));
+    
+    return true;
+}
+
+// Size for the connected channels and data rate of adc, skipping the status word of fetchData() frames
+bool ADS129xSpectrum::begin(ADS129xADC& adc, const uint32_t& updateMs)
+{
+    return begin(adc.sampleRate(), adc.numChCon, updateMs, (adc.recSize > adc.numChCon * BYTES_P_CH)? 1 : 0);
+}
+
+// Add a band in Hz, returns its index or -1 if full, outside 0 to fs/2 or narrower than a bin
+int ADS129xSpectrum::addBand(const float& fLo, const float& fHi)
+{
+    int lo, hi;
+    
+    if (m_numBands >= SPEC_MAX_BANDS || m_nfft == 0)
+        return -1;
+    if (fLo < 0 || fHi > 0.5f * m_fs || fHi - fLo < binHz())
+        return -1;
+    
+    lo = (int)ceilf(fLo / binHz());
+    hi = (int)floorf(fHi / binHz());
+    if (hi > m_nfft / 2)
+        hi = m_nfft / 2;
+    if (hi < lo)
+        return -1;
+    
+    m_bandLo[m_numBands] = lo;
+    m_bandHi[m_numBands] = hi;
+    return m_numBands++;
+}
+
+// Push one frame of numCh samples, returns true when a round of PSD and band power updates completes
+bool ADS129xSpectrum::push(const int32_t* frame)
+{
+    const int32_t* in = frame + m_first;
+    
+    for (int ch = 0; ch < m_numCh; ch++)
+        m_decSum[ch] += in[ch];
+    
+    if (++m_decCount >= m_decim) {
+        m_decCount = 0;
+        for (int ch = 0; ch < m_numCh; ch++) {
+            m_ring[ch][m_pos] = m_decSum[ch] / m_decim;
+            m_decSum[ch] = 0;
+        }
+        
+        if (++m_pos == m_nfft)
+            m_pos = 0;
+        if (m_filled < m_nfft)
+            m_filled++;
+        if (m_sinceUpd < m_hop)
+            m_sinceUpd++;
+        
+        // A hop that ends during a round starts the next one as soon as it completes
+        if (m_updCh < 0 && m_sinceUpd >= m_hop && m_filled == m_nfft) {
+            // Running mean until SPEC_AVG segments are in, exponential average after that
+            m_weight = 1.0f / ((m_segments < SPEC_AVG)? m_segments + 1 : SPEC_AVG);
+            m_roundUs = 0;
+            m_sinceUpd = 0;
+            m_updCh = 0;
+        }
+    }
+    
+    return (m_updCh >= 0)? update() : false;
+}
+
+// Refresh PSD and band power of the next channel in the round, returns true after the last one
+bool ADS129xSpectrum::update()
+{
+    uint32_t start = micros();
+    uint32_t elapsed;
+    const int ch = m_updCh;
+    float df = binHz();
+    
+    updateChannel(ch, m_weight);
+    for (int b = 0; b < m_numBands; b++) {
+        float sum = 0;
+        for (int k = m_bandLo[b]; k <= m_bandHi[b]; k++)
+            sum += m_psd[ch][k];
+        m_bandPow[ch][b] = sum * df;
+    }
+    
+    elapsed = micros() - start;
+    m_roundUs += elapsed;
+    if (elapsed > pushMaxUs)
+        pushMaxUs = elapsed;
+    
+    if (++m_updCh < m_numCh)
+        return false;
+    
+    m_updCh = -1;
+    m_segments++;
+    updateUs = m_roundUs;
+    return true;
+}
+
+// Windowed real FFT of one channel segment folded into its running PSD
+void ADS129xSpectrum::updateChannel(const int& ch, const float& weight)
+{
+    const int32_t* ring = m_ring[ch];
+    const int half = m_nfft / 2;
+    int64_t sum = 0;
+    float mean;
+    int idx = m_pos;        // Oldest sample
+    
+    for (int n = 0; n < m_nfft; n++)
+        sum += ring[n];
+    mean = (float)sum / m_nfft;
+    
+    // Pack even and odd samples as real and imaginary parts of a half length complex sequence
+    for (int n = 0; n < half; n++) {
+        m_re[n] = (ring[idx] - mean) * m_win[2 * n];
+        if (++idx == m_nfft)
+            idx = 0;
+        m_im[n] = (ring[idx] - mean) * m_win[2 * n + 1];
+        if (++idx == m_nfft)
+            idx = 0;
+    }
+    
+    fft();
+    
+    // Split into the spectrum of the real sequence, bins 0 to N/2
+    for (int k = 0; k <= half; k++) {
+        int a = (k == half)? 0 : k;
+        int b = (k == 0)? 0 : half - k;
+        float evR = 0.5f * (m_re[a] + m_re[b]);
+        float evI = 0.5f * (m_im[a] - m_im[b]);
+        float odR = 0.5f * (m_im[a] + m_im[b]);
+        float odI = -0.5f * (m_re[a] - m_re[b]);
+        float c = (k == half)? -1.0f : m_cos[k];
+        float s = (k == half)? 0.0f : m_sin[k];
+        float xr = evR + c * odR + s * odI;
+        float xi = evI + c * odI - s * odR;
+        float p = (xr * xr + xi * xi) * m_scale;
+        
+        if (k != 0 && k != half)
+            p *= 2.0f;      // One sided PSD
+        m_psd[ch][k] += weight * (p - m_psd[ch][k]);
+    }
+}
+
+// In place radix-2 complex FFT of m_nfft/2 points held in m_re/m_im
+void ADS129xSpectrum::fft()
+{
+    const int n = m_nfft / 2;
+    
+    // Bit reversal permutation
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            float t = m_re[i]; m_re[i] = m_re[j]; m_re[j] = t;
+            t = m_im[i]; m_im[i] = m_im[j]; m_im[j] = t;
+        }
+    }
+    
+    // Butterflies, twiddle exp(-2 pi i j / len) = table[j * N / len]
+    for (int len = 2; len <= n; len <<= 1) {
+        int step = m_nfft / len;
+        for (int i = 0; i < n; i += len) {
+            for (int j = 0; j < len / 2; j++) {
+                float wr = m_cos[j * step];
+                float wi = -m_sin[j * step];
+                int u = i + j;
+                int v = u + len / 2;
+                float tr = m_re[v] * wr - m_im[v] * wi;
+                float ti = m_re[v] * wi + m_im[v] * wr;
+                m_re[v] = m_re[u] - tr;
+                m_im[v] = m_im[u] - ti;
+                m_re[u] += tr;
+                m_im[u] += ti;
+            }
+        }
+    }
+}
+
+// Power in band of channel (codes^2)
+float ADS129xSpectrum::bandPower(const int& ch, const int& band)
+{
+    return m_bandPow[ch][band];
+}
+
+// Running PSD of channel, fftSize()/2 + 1 bins (codes^2/Hz)
+const float* ADS129xSpectrum::psd(const int& ch)
+{
+    return m_psd[ch];
+}
+
+// FFT length in use
+int ADS129xSpectrum::fftSize()
+{
+    return m_nfft;
+}
+
+// Bin spacing (Hz)
+float ADS129xSpectrum::binHz()
+{
+    return m_fs / m_nfft;
+}
+
+// Input samples averaged per PSD sample
+int ADS129xSpectrum::decimation()
+{
+    return m_decim;
+}
@@ -0,0 +1,94 @@
+/* Teensy ADS129xADC library
+ * Copyright (C) 2014 by Valentin Goverdovsky
+ *
+ * This file is part of the Teensy ADS129xADC Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Teensy ADS129xADC Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef ADS129xSpectrum_h
+#define ADS129xSpectrum_h
+
+#include "ADS129xADC.h"
+
+#ifndef SPEC_MAX_FFT
+#define SPEC_MAX_FFT    512     // Max FFT length (power of 2), sets the static memory footprint
+#endif  // SPEC_MAX_FFT
+#define SPEC_MIN_FFT    16      // Min FFT length
+#define SPEC_MAX_BANDS  4       // Max number of band power outputs per channel
+#define SPEC_AVG        8       // Number of segments in the running Welch average
+
+// Incremental Welch PSD and band power for all connected channels.
+// Buffers are fixed size member arrays (about 28 KB with the default SPEC_MAX_FFT),
+// so declare the instance globally. Nothing is allocated after begin().
+// Each push() updates at most one channel, so a round of updates spans numCh frames.
+class ADS129xSpectrum
+{
+private:
+    int m_numCh     = 0;
+    int m_nfft      = 0;
+    int m_hop       = 0;
+    int m_pos       = 0;        // Ring write index
+    int m_filled    = 0;        // Samples in the ring, up to m_nfft
+    int m_sinceUpd  = 0;        // Samples pushed since the last update
+    int m_numBands  = 0;
+    int m_decim     = 1;        // Input samples averaged per ring sample
+    int m_decCount  = 0;
+    int m_first     = 0;        // Frame index of the first channel, 1 when a status word leads
+    int m_updCh     = -1;       // Next channel to update in the current round, -1 when idle
+    float m_weight  = 0;        // Welch average weight of the current round
+    uint32_t m_roundUs = 0;
+    uint32_t m_segments = 0;
+    float m_fs      = 0;
+    float m_scale   = 0;        // PSD scale 1/(fs * sum(w^2))
+    int32_t m_decSum[MAX_CH_NUM];
+    int32_t m_ring[MAX_CH_NUM][SPEC_MAX_FFT];
+    float m_win[SPEC_MAX_FFT];
+    float m_cos[SPEC_MAX_FFT / 2];
+    float m_sin[SPEC_MAX_FFT / 2];
+    float m_re[SPEC_MAX_FFT / 2];
+    float m_im[SPEC_MAX_FFT / 2];
+    float m_psd[MAX_CH_NUM][SPEC_MAX_FFT / 2 + 1];
+    int m_bandLo[SPEC_MAX_BANDS];
+    int m_bandHi[SPEC_MAX_BANDS];
+    float m_bandPow[MAX_CH_NUM][SPEC_MAX_BANDS];
+    // In place radix-2 complex FFT of m_nfft/2 points held in m_re/m_im
+    void fft();
+    // Windowed real FFT of one channel segment folded into its running PSD
+    void updateChannel(const int& ch, const float& weight);
+    // Refresh PSD and band power of the next channel in the round, returns true after the last one
+    bool update();
+public:
+    uint32_t updateUs = 0;      // CPU time of the last completed round over all channels (us)
+    uint32_t pushMaxUs = 0;     // Worst CPU time of update work within a single push() since begin() (us)
+    // Decimate sps to at most SPEC_MAX_FFT, size FFT to about 1 s of data, update every updateMs, channels start at frame[first], clears bands
+    bool begin(const uint32_t& sps, const int& numCh, const uint32_t& updateMs = 100, const int& first = 0);
+    // Size for the connected channels and data rate of adc, skipping the status word of fetchData() frames
+    bool begin(ADS129xADC& adc, const uint32_t& updateMs = 100);
+    // Add a band in Hz, returns its index or -1 if full, outside 0 to fs/2 or narrower than a bin
+    int addBand(const float& fLo, const float& fHi);
+    // Push one frame of numCh samples, returns true when a round of PSD and band power updates completes
+    bool push(const int32_t* frame);
+    // Power in band of channel (codes^2)
+    float bandPower(const int& ch, const int& band);
+    // Running PSD of channel, fftSize()/2 + 1 bins (codes^2/Hz)
+    const float* psd(const int& ch);
+    // FFT length in use
+    int fftSize();
+    // Bin spacing (Hz)
+    float binHz();
+    // Input samples averaged per PSD sample
+    int decimation();
+};
+#endif /* ADS129xSpectrum_h */
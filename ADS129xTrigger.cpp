@@ -0,0 +1,169 @@
+/* Teensy ADS129xADC library
+ * Copyright (C) 2014 by Valentin Goverdovsky
+ *
+ * This file is part of the Teensy ADS129xADC Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Teensy ADS129xADC Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include "ADS129xTrigger.h"
+
+// Setup for the frame layout of adc, pre and post trigger lengths in frames, clears triggers
+bool ADS129xTrigger::begin(ADS129xADC& adc, const int& preFrames, const int& postFrames, trigSink sink)
+{
+    if (adc.recSize <= 0 || !sink || preFrames < 0 || postFrames < 0)
+        return false;
+    
+    m_recSize = adc.recSize;
+    m_hasStatus = (adc.recSize > adc.numChCon * BYTES_P_CH);
+    m_nSlots = TRIG_RING_BYTES / m_recSize;
+    
+    // One slot is always kept free for the incoming frame
+    if (preFrames >= m_nSlots)
+        return false;
+    
+    m_pre = preFrames;
+    m_post = postFrames;
+    m_sink = sink;
+    m_head = 0;
+    m_hist = 0;
+    m_postLeft = 0;
+    m_numTrig = 0;
+    m_primed = false;
+    events = 0;
+    committedBytes = 0;
+    discardedBytes = 0;
+    
+    return true;
+}
+
+// Add trigger on connected channel ch, arg is the threshold or the GPIO bit mask, returns its index or -1
+int ADS129xTrigger::addTrigger(const trigType& type, const int& ch, const int32_t& arg)
+{
+    if (m_numTrig >= TRIG_MAX)
+        return -1;
+    
+    switch (type) {
+        case TRIG_LEVEL:
+        case TRIG_SLOPE:
+            if (ch < 0 || (ch + 1 + m_hasStatus) * BYTES_P_CH > m_recSize)
+                return -1;
+            break;
+        default:
+            if (!m_hasStatus)
+                return -1;
+            break;
+    }
+    
+    m_trigType[m_numTrig] = type;
+    m_trigCh[m_numTrig] = ch;
+    m_trigArg[m_numTrig] = arg;
+    m_primed = false;
+    return m_numTrig++;
+}
+
+// Sign extended sample of connected channel ch in frame
+int32_t ADS129xTrigger::sample(const uint8_t* frame, const int& ch)
+{
+    const uint8_t* p = frame + (ch + m_hasStatus) * BYTES_P_CH;
+    return (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8)) >> 8;
+}
+
+// Evaluate all triggers on frame, returns true if any fired
+bool ADS129xTrigger::evaluate(const uint8_t* frame)
+{
+    uint32_t status = 0;
+    uint32_t changed;
+    bool fired = false;
+    
+    if (m_hasStatus)
+        status = ((uint32_t)frame[0] << 16) | ((uint32_t)frame[1] << 8) | frame[2];
+    changed = status ^ m_prevStatus;
+    
+    for (int t = 0; t < m_numTrig; t++) {
+        int32_t x, mag;
+        switch (m_trigType[t]) {
+            case TRIG_LEVEL:
+                x = sample(frame, m_trigCh[t]);
+                mag = (x < 0)? -x : x;
+                fired |= m_primed && mag >= m_trigArg[t] && m_prev[t] < m_trigArg[t];
+                m_prev[t] = mag;
+                break;
+            case TRIG_SLOPE:
+                x = sample(frame, m_trigCh[t]);
+                mag = x - m_prev[t];
+                fired |= m_primed && ((mag < 0)? -mag : mag) >= m_trigArg[t];
+                m_prev[t] = x;
+                break;
+            case TRIG_GPIO:
+                fired |= m_primed && (changed & m_trigArg[t] & TRIG_GPIO_BITS);
+                break;
+            case TRIG_LOFF:
+                fired |= m_primed && (changed & TRIG_LOFF_BITS);
+                break;
+        }
+    }
+    
+    m_prevStatus = status;
+    m_primed = true;
+    return fired;
+}
+
+// Buffer to fetch the next frame into
+uint8_t* ADS129xTrigger::frameSlot()
+{
+    return m_ring + m_head * m_recSize;
+}
+
+// Evaluate the frame fetched into frameSlot() and commit or hold it, returns true if a trigger fired
+bool ADS129xTrigger::commitFrame()
+{
+    uint8_t* frame = frameSlot();
+    bool fired = evaluate(frame);
+    
+    if (m_postLeft > 0) {
+        // Inside a capture window, pass the frame straight on and extend the window on a new trigger
+        m_sink(frame, m_recSize);
+        committedBytes += m_recSize;
+        m_postLeft = fired? m_post : m_postLeft - 1;
+    }
+    else if (fired) {
+        // Commit history and trigger frame, in two pieces if the history wraps
+        int first = m_head - m_hist;
+        int n = m_hist + 1;
+        if (first < 0) {
+            first += m_nSlots;
+            m_sink(m_ring + first * m_recSize, (m_nSlots - first) * m_recSize);
+            m_sink(m_ring, (m_head + 1) * m_recSize);
+        }
+        else {
+            m_sink(m_ring + first * m_recSize, n * m_recSize);
+        }
+        committedBytes += n * m_recSize;
+        m_hist = 0;
+        m_postLeft = m_post;
+        events++;
+    }
+    else if (m_hist < m_pre) {
+        m_hist++;
+    }
+    else {
+        discardedBytes += m_recSize;    // Oldest history frame (or this one without history) is dropped
+    }
+    
+    if (++m_head == m_nSlots)
+        m_head = 0;
+    
+    return fired;
+}
@@ -0,0 +1,82 @@
+/* Teensy ADS129xADC library
+ * Copyright (C) 2014 by Valentin Goverdovsky
+ *
+ * This file is part of the Teensy ADS129xADC Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Teensy ADS129xADC Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef ADS129xTrigger_h
+#define ADS129xTrigger_h
+
+#include "ADS129xADC.h"
+
+#ifndef TRIG_RING_BYTES
+#define TRIG_RING_BYTES 8192    // Pre-trigger history storage, sets the max pre-trigger length
+#endif  // TRIG_RING_BYTES
+#define TRIG_MAX        4       // Max number of triggers evaluated per frame
+#define TRIG_LOFF_BITS  0xFFFF0 // LOFF_STATP and LOFF_STATN bits in the status word
+#define TRIG_GPIO_BITS  0x0000F // GPIO bits in the status word
+
+// Define trigger types
+enum trigType
+{
+    TRIG_LEVEL = 0, // Magnitude of channel rises to or above threshold
+    TRIG_SLOPE,     // Magnitude of change between frames on channel reaches threshold
+    TRIG_GPIO,      // Any of the selected GPIO status bits changes (needs GPIO data)
+    TRIG_LOFF       // Any lead-off status bit changes (needs GPIO data)
+};
+
+// Sink receiving committed data, called with pointers into the capture ring
+typedef void (*trigSink)(const uint8_t* data, const int& len);
+
+// Event triggered capture of raw recSize frames with a pre-trigger history
+class ADS129xTrigger
+{
+private:
+    uint8_t m_ring[TRIG_RING_BYTES];
+    int m_recSize   = 0;
+    int m_nSlots    = 0;
+    int m_head      = 0;        // Slot the next frame is fetched into
+    int m_hist      = 0;        // Uncommitted frames held before m_head
+    int m_pre       = 0;
+    int m_post      = 0;
+    int m_postLeft  = 0;        // Frames left in the current post-trigger window
+    int m_numTrig   = 0;
+    bool m_hasStatus = false;
+    bool m_primed   = false;
+    trigSink m_sink = 0;
+    trigType m_trigType[TRIG_MAX];
+    int m_trigCh[TRIG_MAX];
+    int32_t m_trigArg[TRIG_MAX];
+    int32_t m_prev[TRIG_MAX];
+    uint32_t m_prevStatus = 0;
+    // Sign extended sample of connected channel ch in frame
+    int32_t sample(const uint8_t* frame, const int& ch);
+    // Evaluate all triggers on frame, returns true if any fired
+    bool evaluate(const uint8_t* frame);
+public:
+    uint32_t events         = 0;    // Number of capture windows opened
+    uint32_t committedBytes = 0;    // Bytes passed to the sink
+    uint32_t discardedBytes = 0;    // Bytes dropped from the history without a trigger
+    // Setup for the frame layout of adc, pre and post trigger lengths in frames, clears triggers
+    bool begin(ADS129xADC& adc, const int& preFrames, const int& postFrames, trigSink sink);
+    // Add trigger on connected channel ch, arg is the threshold or the GPIO bit mask, returns its index or -1
+    int addTrigger(const trigType& type, const int& ch, const int32_t& arg);
+    // Buffer to fetch the next frame into
+    uint8_t* frameSlot();
+    // Evaluate the frame fetched into frameSlot() and commit or hold it, returns true if a trigger fired
+    bool commitFrame();
+};
+#endif /* ADS129xTrigger_h */
@@ -0,0 +1,80 @@
+// Calibration benchmark for the ADS129xADC library
+//
+// Prints the offset, noise and health readings of one calibration cycle, the
+// streaming downtime it costs, and the per sample overhead of fetching offset
+// corrected samples compared with raw bytes.
+#include "ADS129xInfo.h"
+#include "ADS129xADC.h"
+
+#define NUM_FRAMES      2000
+#define CAL_SAMPLES     256
+
+ADS129xADC adc;
+chType chSpec[MAX_CH_NUM] = {PHY, PHY, PHY, PHY, PHY, PHY, PHY, PHY};
+uint8_t rawData[(MAX_CH_NUM + 1) * BYTES_P_CH];
+int32_t corrData[MAX_CH_NUM + 1];
+
+// Wait for the next frame
+void waitFrame()
+{
+    while (digitalReadFast(ADS_DRDY_PIN) == HIGH);
+}
+
+void setup()
+{
+    uint32_t rawUs = 0;
+    uint32_t corrUs = 0;
+    uint32_t start;
+    
+    Serial.begin(115200);
+    while (!Serial);
+    
+    adc.startUp();
+    adc.setAqParams(HIGH_RES_1k_SPS, false, chSpec);
+    adc.startStream();
+    
+    adc.calibrate(CAL_SAMPLES);
+    Serial.print("Calibration downtime (us): ");
+    Serial.println(adc.calInfo.downtimeUs);
+    Serial.print("Samples lost: ");
+    Serial.println(adc.lastGap.lostSamples);
+    for (int i = 0; i < adc.numChAv; i++) {
+        Serial.print("CH");
+        Serial.print(i + 1);
+        Serial.print(" offset ");
+        Serial.print(adc.calInfo.offset[i]);
+        Serial.print(" noise ");
+        Serial.println(adc.calInfo.noise[i]);
+    }
+    Serial.print("Temperature (C): ");
+    Serial.println(adc.calInfo.tempC);
+    Serial.print("AVDD (V): ");
+    Serial.println(adc.calInfo.avddV);
+    Serial.print("DVDD (V): ");
+    Serial.println(adc.calInfo.dvddV);
+    
+    // Time the fetch only, not the wait for DRDY
+    for (int n = 0; n < NUM_FRAMES; n++) {
+        waitFrame();
+        start = micros();
+        adc.fetchData(rawData);
+        rawUs += micros() - start;
+    }
+    for (int n = 0; n < NUM_FRAMES; n++) {
+        waitFrame();
+        start = micros();
+        adc.fetchData(corrData);
+        corrUs += micros() - start;
+    }
+    
+    Serial.print("Raw fetch per frame (us): ");
+    Serial.println((float)rawUs / NUM_FRAMES);
+    Serial.print("Corrected fetch per frame (us): ");
+    Serial.println((float)corrUs / NUM_FRAMES);
+    Serial.print("Correction overhead per sample (ns): ");
+    Serial.println(1000.0f * ((float)corrUs - rawUs) / ((float)NUM_FRAMES * adc.numChCon));
+}
+
+void loop()
+{
+}
@@ -0,0 +1,52 @@
+// Derived lead benchmark for the ADS129xLeads re-referencing engine
+//
+// Runs the 12-lead ECG preset (8 inputs to 12 outputs) and a 16 channel common
+// average over blocks of synthetic frames and prints frames/s. No ADC needed.
+#include "ADS129xLeads.h"
+
+#define NUM_FRAMES      256
+#define NUM_PASSES      200
+
+ADS129xLeads leads;
+int32_t inData[NUM_FRAMES * LEADS_MAX_IN];
+int32_t outData[NUM_FRAMES * LEADS_MAX_OUT];
+
+// Time NUM_PASSES passes over the frame block and print frames/s
+void bench(const char* name, const int& numIn)
+{
+    uint32_t start;
+    uint32_t elapsed;
+    
+    for (int n = 0; n < NUM_FRAMES * numIn; n++)
+        inData[n] = (int32_t)(n * 2654435761UL) >> 8;   // Spread of 24-bit values
+    
+    start = micros();
+    for (int p = 0; p < NUM_PASSES; p++)
+        leads.apply(inData, outData, NUM_FRAMES);
+    elapsed = micros() - start;
+    
+    Serial.print(name);
+    Serial.print(": ");
+    Serial.print(numIn);
+    Serial.print(" in, ");
+    Serial.print(leads.numOut());
+    Serial.print(" out, frames/s ");
+    Serial.println(1e6f * NUM_FRAMES * NUM_PASSES / elapsed);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    while (!Serial);
+    
+    if (leads.setEinthoven12(8))
+        bench("12-lead ECG", 8);
+    if (leads.setCommonAverage(16, 0, 16))
+        bench("Common average", 16);
+    if (leads.setBipolar(16, 0, 16))
+        bench("Bipolar chain", 16);
+}
+
+void loop()
+{
+}
@@ -0,0 +1,64 @@
+// Live reconfiguration benchmark for the ADS129xADC library
+//
+// Streams at 1 kS/s and applies a series of setup changes with reconfigure(),
+// printing the register writes, gap length and lost samples of each one.
+#include "ADS129xInfo.h"
+#include "ADS129xADC.h"
+
+#define SETTLE_FRAMES   100
+
+ADS129xADC adc;
+chType phySpec[MAX_CH_NUM] = {PHY, PHY, PHY, PHY, NC, NC, NC, NC};
+chType senSpec[MAX_CH_NUM] = {PHY, PHY, SEN, SEN, NC, NC, NC, NC};
+uint8_t chData[(MAX_CH_NUM + 1) * BYTES_P_CH];
+
+// Fetch frames so each change starts right after a fetch, as reconfigure() expects
+void stream(const int& nFrames)
+{
+    for (int n = 0; n < nFrames; n++) {
+        while (digitalReadFast(ADS_DRDY_PIN) == HIGH);
+        adc.fetchData(chData);
+    }
+}
+
+// Apply a setup and report the gap it left
+void change(const char* name, const uint8_t& res_speed, const chType chSpec[], const uint8_t& gain)
+{
+    int writes;
+    int lost;
+    
+    stream(SETTLE_FRAMES);
+    writes = adc.reconfigure(res_speed, false, chSpec, false, gain);
+    while (digitalReadFast(ADS_DRDY_PIN) == HIGH);
+    lost = adc.fetchData(chData);
+    
+    Serial.print(name);
+    Serial.print(": writes ");
+    Serial.print(writes);
+    Serial.print(", gap (us) ");
+    Serial.print(adc.lastGap.lengthUs);
+    Serial.print(", lost samples ");
+    Serial.print(adc.lastGap.lostSamples);
+    Serial.print(", reported by fetchData ");
+    Serial.println(lost);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    while (!Serial);
+    
+    adc.startUp();
+    adc.setAqParams(HIGH_RES_1k_SPS, false, phySpec);
+    adc.startStream();
+    
+    change("No change", HIGH_RES_1k_SPS, phySpec, GAIN_X12);
+    change("Gain 12 to 6", HIGH_RES_1k_SPS, phySpec, GAIN_X6);
+    change("Channel type PHY to SEN", HIGH_RES_1k_SPS, senSpec, GAIN_X6);
+    change("Rate 1k to 2k", HIGH_RES_2k_SPS, senSpec, GAIN_X6);
+    change("Back to initial setup", HIGH_RES_1k_SPS, phySpec, GAIN_X12);
+}
+
+void loop()
+{
+}
@@ -0,0 +1,75 @@
+// Single-shot duty cycling benchmark for the ADS129xADC library
+//
+// Acquires one SEN channel for NUM_SEC seconds in continuous mode at 250 S/s,
+// then for NUM_SEC seconds in single-shot mode at SHOT_PERIOD_MS, and prints
+// samples, bus transactions per sample, duty cycle and wake to data latency.
+#include "ADS129xInfo.h"
+#include "ADS129xADC.h"
+
+#define NUM_SEC         10
+#define SHOT_PERIOD_MS  200
+#define BATCH_LEN       10
+
+ADS129xADC adc;
+chType chSpec[MAX_CH_NUM] = {SEN, NC, NC, NC, NC, NC, NC, NC};
+uint8_t chData[(MAX_CH_NUM + 1) * BYTES_P_CH];
+uint8_t batch[BATCH_LEN * (MAX_CH_NUM + 1) * BYTES_P_CH];
+
+void setup()
+{
+    uint32_t samples = 0;
+    uint32_t batches = 0;
+    uint32_t tx;
+    uint32_t start;
+    
+    Serial.begin(115200);
+    while (!Serial);
+    
+    adc.startUp();
+    adc.setAqParams(LOW_POWR_250_SPS, false, chSpec);
+    
+    // Continuous mode, the ADC is awake the whole time
+    tx = adc.busTransactions();
+    start = millis();
+    adc.startStream();
+    while (millis() - start < NUM_SEC * 1000UL) {
+        while (digitalReadFast(ADS_DRDY_PIN) == HIGH);
+        adc.fetchData(chData);
+        samples++;
+    }
+    adc.stopStream();
+    tx = adc.busTransactions() - tx;
+    
+    Serial.print("Continuous: samples ");
+    Serial.print(samples);
+    Serial.print(", bus transactions per sample ");
+    Serial.print((float)tx / samples);
+    Serial.println(", duty cycle 100%");
+    
+    // Single-shot mode, awake only to convert and read
+    start = millis();
+    if (!adc.startSingleShot(SHOT_PERIOD_MS, batch, BATCH_LEN)) {
+        Serial.println("Single-shot: invalid batch");
+        return;
+    }
+    while (millis() - start < NUM_SEC * 1000UL) {
+        if (adc.serviceSingleShot())
+            batches++;
+    }
+    adc.stopSingleShot();
+    
+    Serial.print("Single-shot: samples ");
+    Serial.print(adc.shotStats.samples);
+    Serial.print(", batches ");
+    Serial.print(batches);
+    Serial.print(", bus transactions per sample ");
+    Serial.print((float)adc.shotStats.busTx / adc.shotStats.samples);
+    Serial.print(", duty cycle (%) ");
+    Serial.print(100.0f * adc.shotStats.awakeUs / adc.shotStats.elapsedUs);
+    Serial.print(", wake to data latency (us) ");
+    Serial.println(adc.shotStats.latencyUs);
+}
+
+void loop()
+{
+}
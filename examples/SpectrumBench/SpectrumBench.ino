@@ -0,0 +1,66 @@
+// Spectral stage benchmark for the ADS129xSpectrum Welch PSD
+//
+// Feeds NUM_SEC seconds of a synthetic 10 Hz sine (amplitude 1000 codes) on 8
+// channels at each ADC data rate from 250 S/s to 16 kS/s with 100 ms updates,
+// and prints FFT size, decimation, alpha/beta band power and CPU per channel.
+// Alpha band power should read about 5e5 codes^2 at every rate. No ADC needed.
+#include "ADS129xSpectrum.h"
+
+#define NUM_SEC         10
+#define NUM_CH          8
+#define SINE_HZ         10
+#define MAX_PERIOD      (16000 / SINE_HZ)
+
+ADS129xSpectrum spectrum;
+int32_t sine[MAX_PERIOD];
+int32_t frame[NUM_CH];
+const uint32_t rates[] = {250, 500, 1000, 2000, 4000, 8000, 16000};
+
+void setup()
+{
+    Serial.begin(115200);
+    while (!Serial);
+    
+    for (unsigned r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        uint32_t sps = rates[r];
+        int period = sps / SINE_HZ;
+        uint32_t start;
+        uint32_t elapsed;
+        
+        // One period of the test tone, generated outside the timed loop
+        for (int n = 0; n < period; n++)
+            sine[n] = (int32_t)lroundf(1000.0f * sinf(2.0f * (float)M_PI * n / period));
+        
+        spectrum.begin(sps, NUM_CH, 100);
+        spectrum.addBand(8, 12);
+        spectrum.addBand(13, 30);
+        
+        start = micros();
+        for (uint32_t n = 0; n < sps * NUM_SEC; n++) {
+            for (int ch = 0; ch < NUM_CH; ch++)
+                frame[ch] = sine[n % period];
+            spectrum.push(frame);
+        }
+        elapsed = micros() - start;
+        
+        Serial.print(sps);
+        Serial.print(" S/s: FFT ");
+        Serial.print(spectrum.fftSize());
+        Serial.print(", decimation ");
+        Serial.print(spectrum.decimation());
+        Serial.print(", alpha ");
+        Serial.print(spectrum.bandPower(0, 0));
+        Serial.print(", beta ");
+        Serial.print(spectrum.bandPower(0, 1));
+        Serial.print(", last round (us) ");
+        Serial.print(spectrum.updateUs);
+        Serial.print(", worst push (us) ");
+        Serial.print(spectrum.pushMaxUs);
+        Serial.print(", CPU per channel (%) ");
+        Serial.println(100.0f * elapsed / (NUM_SEC * 1e6f * NUM_CH), 4);
+    }
+}
+
+void loop()
+{
+}
@@ -0,0 +1,83 @@
+// Trigger capture benchmark for ADS129xTrigger
+//
+// Runs NUM_FRAMES synthetic 1 kS/s frames (8 channels plus status word) with an
+// event every EVENT_EVERY frames through level and lead-off triggers, and prints
+// the evaluation cost per frame and committed versus discarded bandwidth.
+// No ADC needed, the frame layout is set directly.
+#include "ADS129xTrigger.h"
+
+#define NUM_FRAMES      100000
+#define EVENT_EVERY     10000
+#define PRE_FRAMES      200
+#define POST_FRAMES     300
+#define FRAME_RATE      1000
+
+ADS129xADC adc;
+ADS129xTrigger trig;
+uint8_t quiet[(MAX_CH_NUM + 1) * BYTES_P_CH];
+uint8_t spike[(MAX_CH_NUM + 1) * BYTES_P_CH];
+uint32_t sinkBytes = 0;
+
+// Sink standing in for storage, only counts what it is given
+void sink(const uint8_t* data, const int& len)
+{
+    (void)data;
+    sinkBytes += len;
+}
+
+// Copy frame n of the synthetic stream into buf
+void makeFrame(uint8_t* buf, const uint32_t& n)
+{
+    memcpy(buf, (n % EVENT_EVERY == EVENT_EVERY / 2)? spike : quiet, adc.recSize);
+}
+
+void setup()
+{
+    uint8_t scratch[(MAX_CH_NUM + 1) * BYTES_P_CH];
+    uint32_t start;
+    uint32_t baseUs;
+    uint32_t trigUs;
+    float seconds = (float)NUM_FRAMES / FRAME_RATE;
+    
+    Serial.begin(115200);
+    while (!Serial);
+    
+    adc.numChCon = MAX_CH_NUM;
+    adc.recSize = (MAX_CH_NUM + 1) * BYTES_P_CH;
+    memset(quiet, 0, sizeof(quiet));
+    quiet[0] = 0xC0;                // Status word header
+    memcpy(spike, quiet, sizeof(spike));
+    spike[BYTES_P_CH + 1] = 0x40;   // Channel 1 at 0x004000
+    
+    trig.begin(adc, PRE_FRAMES, POST_FRAMES, sink);
+    trig.addTrigger(TRIG_LEVEL, 0, 0x2000);
+    trig.addTrigger(TRIG_LOFF, 0, 0);
+    
+    // Cost of producing the frames alone, subtracted below
+    start = micros();
+    for (uint32_t n = 0; n < NUM_FRAMES; n++)
+        makeFrame(scratch, n);
+    baseUs = micros() - start;
+    
+    start = micros();
+    for (uint32_t n = 0; n < NUM_FRAMES; n++) {
+        makeFrame(trig.frameSlot(), n);
+        trig.commitFrame();
+    }
+    trigUs = micros() - start;
+    
+    Serial.print("Events: ");
+    Serial.println(trig.events);
+    Serial.print("Evaluate and commit per frame (ns): ");
+    Serial.println(1000.0f * ((float)trigUs - baseUs) / NUM_FRAMES);
+    Serial.print("Committed (B/s): ");
+    Serial.println(trig.committedBytes / seconds);
+    Serial.print("Discarded (B/s): ");
+    Serial.println(trig.discardedBytes / seconds);
+    Serial.print("Sink received (B): ");
+    Serial.println(sinkBytes);
+}
+
+void loop()
+{
+}